@@ -2,25 +2,14 @@
 #include "pico/stdlib.h"
 #include <string.h>
 #include "hardware/adc.h"
+#include "hardware/sync.h"
 #include "matrix_display.hpp"
 #include "pindefs.hpp"
 #include "pico_flash.hpp"
+#include "brightness.hpp"
 #include "clw_dbgutils.h"
 
 #define STR_BUFFER_LEN 128
-// Number of temperature samples of the "baseline" room temperature to take on startup
-#define BASELINE_SAMPLES 128
-// Offset to add to baseline to account for self-heating after turning on the card
-#define BASELINE_OFFSET -0.1f
-// Number of samples to average for temperature reading
-#define AVERAGE_WINDOW 32
-// ADC reading to brightness coefficient
-#define TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF 0.15f
-// Minimum and maximum brightness levels
-#define MAX_BRIGHTNESS 1.0f
-#define MIN_BRIGHTNESS 0.05f
-
-#define DEBUG_TEMPERATURE_PRINT 1
 
 void init_gpio(void){
     gpio_init_mask(MASK_ALL_COLS|MASK_ALL_ROWS);
@@ -41,17 +30,11 @@ void init_gpio(void){
     adc_select_input(4);
 }
 
-uint counter = 0;
-uint scroll_count = 0;
 const uint8_t * current_char;
 
-float current_brightness = 0.05f;
-float baseline_adc_temp = 0;
-
 // Function to read temperature and update brightness
 void update_brightness_from_temp(void) {
     static uint32_t last_update = 0;
-    static uint32_t last_debug_print = 0;
     uint32_t now = to_ms_since_boot(get_absolute_time());
     
     // Update only every 50ms
@@ -60,71 +43,7 @@ void update_brightness_from_temp(void) {
     }
     last_update = now;
     
-    uint16_t raw_adc_temp = adc_read();
-
-    static float adc_history[AVERAGE_WINDOW] = {0};
-    static uint8_t adc_index = 0;
-    static bool history_filled = false;
-
-    // Add to averaging window of AVERAGE_WINDOW samples
-    adc_history[adc_index] = raw_adc_temp;
-    adc_index = (adc_index + 1) % AVERAGE_WINDOW;
-    if (adc_index == 0) history_filled = true;
-    
-    // Calculate average temperature
-    float adc_temp = 0;
-    uint8_t samples = history_filled ? AVERAGE_WINDOW : (adc_index == 0 ? AVERAGE_WINDOW : adc_index);
-    for (uint8_t i = 0; i < samples; i++) {
-        adc_temp += adc_history[i];
-    }
-    adc_temp /= samples;
-    
-    static uint8_t baseline_count = 0;
-    static float baseline_sum = 0;
-    
-    // Measure baseline temperature over first 20 readings
-    if (baseline_count < BASELINE_SAMPLES) {
-        baseline_sum += adc_temp;
-        baseline_count++;
-        baseline_adc_temp = BASELINE_OFFSET + (baseline_sum / baseline_count);
-        if (baseline_count == BASELINE_SAMPLES) {
-            printf("Baseline ADC temp (averaged): %.1f\n", baseline_adc_temp);
-        }
-    }
-
-    float temp_diff = adc_temp - baseline_adc_temp;
-
-    // Absolute, so heating and cooling have same effect
-    float abs_temp_diff = temp_diff;
-    if (abs_temp_diff < 0) abs_temp_diff = -abs_temp_diff;
-
-    float brightness_change = abs_temp_diff * abs_temp_diff * TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF;
-    float target_brightness = brightness_change;
-
-    // Clamp brightness to 5% to 100% of max brightness
-    if (target_brightness > MAX_BRIGHTNESS) {
-        target_brightness = MAX_BRIGHTNESS;
-    }
-    if (target_brightness < MIN_BRIGHTNESS) {
-        target_brightness = MIN_BRIGHTNESS;
-    }
-    
-    // Smoothly update current brightness - faster decay when decreasing
-    if (target_brightness < current_brightness) {
-        // Faster response when dimming
-        current_brightness = current_brightness * 0.3f + target_brightness * 0.7f;
-    } else {
-        // Slower response when brightening
-        current_brightness = current_brightness * 0.98f + target_brightness * 0.02f;
-    }
-
-#if DEBUG_TEMPERATURE_PRINT
-    if (now - last_debug_print > 1000) {
-        printf("ADC: %.1f, Baseline: %.1f, RawDiff: %.1f, AbsDiff: %.1f, Brightness: %.1f%%\n", 
-               adc_temp, baseline_adc_temp, temp_diff, abs_temp_diff, current_brightness * 100.0f);
-        last_debug_print = now;
-    }
-#endif
+    update_brightness(adc_read(), now);
 }
 
 //const char * testString = ;
@@ -150,29 +69,35 @@ char * strings[] = {
     easterEggStr
 };
 uint8_t tempBufferIdx = 0;
-void scroll_screen(void){
-    scroll_chars();
-    scroll_count++;
-    if(scroll_count==7){
-        counter = (counter+1) % strlen(strings[display_mode]);
-        const uint8_t * disp_char = char_to_matrix(strings[display_mode][counter]);
-        add_char_to_scroll(disp_char);
-        scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
-    }
-}
-
-void screen_start(void){
-    const uint8_t * disp_char = char_to_matrix(strings[display_mode][counter]);
-    add_char_to_scroll(disp_char);
-    scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
-}
+// Copy of scroll_buff taken right after each scroll step, for the mirror
+uint8_t mirror_snapshot[15] = {0};
+volatile bool mirror_snapshot_ready = false;
 
 repeating_timer_t scroll_timer = {0};
 bool scroll_timer_cb(repeating_timer_t * timer){
-    scroll_screen();
+    scroll_screen(strings[display_mode]);
+#if MIRROR_FPS
+    memcpy(mirror_snapshot, scroll_buff, sizeof(mirror_snapshot));
+    mirror_snapshot_ready = true;
+#endif
     return true;
 }
 
+// Send the latest scroll step to the mirror, if there's a new one. Called from the
+// display loop so it keeps up with the scroll timer rather than the button polling
+void mirror_poll(void){
+#if MIRROR_FPS
+    if(mirror_snapshot_ready){
+        uint8_t frame[15];
+        uint32_t irq_status = save_and_disable_interrupts();
+        memcpy(frame, mirror_snapshot, sizeof(frame));
+        mirror_snapshot_ready = false;
+        restore_interrupts(irq_status);
+        mirror_frame(frame);
+    }
+#endif
+}
+
 void print_info(void){
     printf("------------------------------------------------\n");
     printf(BR_BLUE "ECSE LEAVERS DINNER INVITATIONS 2025\n" COLOUR_NONE);
@@ -198,7 +123,7 @@ int main()
     stdio_init_all();
     init_gpio();
     read_name_from_flash(userStringBuffer, STR_BUFFER_LEN);
-    screen_start();
+    screen_start(strings[display_mode]);
     printf("hello, world!");
     add_repeating_timer_ms(-100,scroll_timer_cb,0,&scroll_timer);
     
@@ -209,26 +134,14 @@ int main()
         if((pb1_last != pb1_val)||(pb2_last!=pb2_val)){
             if((pb1_val==0) &&(pb2_val ==0)){
                 display_mode = EASTER;
-                counter = 0;
-                const uint8_t * disp_char = char_to_matrix(strings[display_mode][counter]);
-                add_char_to_scroll_start(disp_char);
-                add_char_to_scroll(disp_char);
-                scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+                screen_restart(strings[display_mode]);
             }else if((pb1_val == 0)){
                 display_mode = ECSE;
-                counter = 0;
-                const uint8_t * disp_char = char_to_matrix(strings[display_mode][counter]);
-                add_char_to_scroll_start(disp_char);
-                add_char_to_scroll(disp_char);
-                scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+                screen_restart(strings[display_mode]);
                 print_info();
             }else if(pb2_val == 0){
                 display_mode = USER;
-                counter = 0;
-                const uint8_t * disp_char = char_to_matrix(strings[display_mode][counter]);
-                add_char_to_scroll_start(disp_char);
-                add_char_to_scroll(disp_char);
-                scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+                screen_restart(strings[display_mode]);
             }
             
             //add_char_to_scroll(char_to_matrix(stringBuffer[counter]));
@@ -246,6 +159,7 @@ int main()
         for(int i = 0; i < 100; i++){
             update_brightness_from_temp();
             disp_char(current_char, current_brightness); 
+            mirror_poll();
             //This is janky - ISRs were being weird so we just do 100 display cycles for every button poll
             //which means our polling rate is worst case 100us*25*100 = 250ms.
             //if ISRs still funky maybe throw this on core 1? would be cool and leave core 0 available for user code/polling.
@@ -265,7 +179,7 @@ int main()
                 if(!rc){
                     printf("wrote string \"%s\" (%d bytes) to flash\n", userStringBuffer, strlen(userStringBuffer)+1);
                 }
-                counter = 0;
+                screen_restart(strings[display_mode]);
                 tempBuffer[0] = ' ';
                 tempBufferIdx = 1;
             }
@@ -0,0 +1,410 @@
+/*--------------------------------------------------
+ * bench_render.cpp
+ * Host benchmarks for the rendering core: char_to_matrix(), the scroll path
+ * (scroll_chars()/add_char_to_scroll() via scroll_screen()), disp_char() and
+ * the brightness update.
+ *
+ * Each benchmark reports host throughput/latency plus:
+ *  - "rel": its cost per op in iterations of a fixed integer calibration loop.
+ *    Dividing by the calibration loop takes out most of the speed difference
+ *    between host machines, so rel can be compared against stored baselines.
+ *    It's a host measure though - the host has hardware float and 64 bit
+ *    multiply, so soft-float and __aeabi_lmul costs don't show up in it.
+ *  - "M0+ cyc": estimated RP2040 cycles per op from the op-count model in
+ *    host/m0_model.hpp. That counts the Thumb-1 instructions and library calls
+ *    (__aeabi_lmul, divides, soft-float) each path runs and weights them by
+ *    their M0+ cost. It's deterministic, so it's gated much tighter than rel.
+ *    A breakdown by instruction class is printed after the results.
+ *
+ * Exits with 1 if a benchmark's rel is more than BASELINE_TOLERANCE over its
+ * baseline in RECHECKS separate measurements, or its M0+ estimate is more than
+ * M0_TOLERANCE over baseline.
+ *
+ * usage: render_bench [baselines.txt] [--update]
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "pico/stdlib.h"
+#include "matrix_display.hpp"
+#include "brightness.hpp"
+#include "m0_model.hpp"
+
+// How far over baseline (as a fraction) an estimate can be before we fail
+#define BASELINE_TOLERANCE 0.3
+#define M0_TOLERANCE 0.01
+// Timed rounds over the whole suite - the fastest run of each benchmark is kept.
+// Interleaving the benchmarks means one noisy patch can't hit every run of one benchmark
+#define ROUNDS 15
+// A benchmark only fails if it's over baseline this many times in a row
+#define RECHECKS 3
+// --update keeps the fastest of this many full measurements
+#define UPDATE_PASSES 5
+// Ops per latency sample, and number of latency samples
+#define LATENCY_BATCH 16
+#define LATENCY_SAMPLES 2000
+
+volatile uint32_t host_gpio_out = 0;
+uint64_t host_time_us = 0;
+uint64_t m0_block_runs[M0_NUM_BLOCKS];
+
+// Results get folded into here so the compiler can't throw the work away
+static volatile uint32_t sink = 0;
+
+static uint64_t now_ns(void){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*--------------------------------------------------
+ * Calibration loop - the unit rel is measured in
+ */
+#define CALIBRATION_ITERS (1u<<21)
+static volatile uint32_t calibration_acc = 1;
+static void run_calibration(uint32_t n){
+    for(uint32_t i = 0; i < n; i++){
+        uint32_t a = calibration_acc;
+        calibration_acc = (a + (a>>3)) ^ i;
+    }
+}
+
+/*--------------------------------------------------
+ * Message sets
+ */
+static const char * default_msgs[] = {
+    " Use PuTTY to Program (115200b)",
+    " ECSE LEAVERS 2025",
+    " COMPSYS ON TOP"
+};
+static const char * symbol_msg = " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+static char long_msg[128];
+
+static void init_msgs(void){
+    // 127 chars of mixed case, digits and punctuation, like a long name + message
+    const char * src = "The quick brown fox jumps over the lazy dog 0123456789 - ECSE Leavers Dinner 2025! ";
+    size_t src_len = strlen(src);
+    for(size_t i = 0; i < sizeof(long_msg)-1; i++){
+        long_msg[i] = src[i % src_len];
+    }
+    long_msg[sizeof(long_msg)-1] = 0;
+}
+
+/*--------------------------------------------------
+ * Benchmarks - each runs n ops
+ */
+static void bench_char_to_matrix(uint32_t n){
+    char c = ' ';
+    for(uint32_t i = 0; i < n; i++){
+        sink += char_to_matrix(c)[1];
+        c = (c == '~') ? ' ' : c+1;
+    }
+}
+
+static void scroll_msg(const char * str, uint32_t n){
+    for(uint32_t i = 0; i < n; i++){
+        scroll_screen(str);
+    }
+    sink += scroll_buff[7];
+}
+static void bench_scroll_default(uint32_t n){
+    scroll_msg(default_msgs[1], n);
+}
+static void bench_scroll_long(uint32_t n){
+    scroll_msg(long_msg, n);
+}
+static void bench_scroll_symbols(uint32_t n){
+    scroll_msg(symbol_msg, n);
+}
+
+// Button mashing: restart on a new string then get a few columns in before the next switch
+static void bench_mode_switch(uint32_t n){
+    static uint mode = 0;
+    for(uint32_t i = 0; i < n; i++){
+        mode = (mode+1) % 3;
+        screen_restart(default_msgs[mode]);
+        scroll_screen(default_msgs[mode]);
+        scroll_screen(default_msgs[mode]);
+        scroll_screen(default_msgs[mode]);
+    }
+    sink += scroll_buff[7];
+}
+
+// One pass over the matrix - the sleeps are stubbed, so this is just the scan overhead
+static void bench_disp_char(uint32_t n){
+    static const char * msg = default_msgs[1];
+    for(uint32_t i = 0; i < n; i++){
+        if((i & 0x0F) == 0){
+            scroll_screen(msg);
+        }
+        disp_char(scroll_buff, current_brightness);
+    }
+    sink += host_gpio_out;
+}
+
+// Slow drift +-3 counts around room temperature, plus a little noise
+static uint16_t fake_adc_temp(uint32_t i){
+    int32_t drift = (int32_t)((i >> 6) % 12);
+    drift = (drift < 6) ? drift : 12-drift;
+    return (uint16_t)(873 + drift + ((i*2654435761u) >> 31));
+}
+// Always replays the trace from the start so every run sees the same mix of dimming/brightening
+static void bench_brightness(uint32_t n){
+    for(uint32_t i = 0; i < n; i++){
+        update_brightness(fake_adc_temp(i), 0);
+    }
+    sink += current_brightness.raw;
+}
+
+// Op counts are fixed (not scaled to the machine's speed) so every run walks the
+// same inputs through the same state, and results don't depend on timing
+struct benchmark {
+    const char * name;
+    void (*run)(uint32_t n);
+    uint32_t iters;
+};
+
+static const benchmark benchmarks[] = {
+    {"char_to_matrix",          bench_char_to_matrix,   1u<<21},
+    {"scroll_screen/default",   bench_scroll_default,   1u<<19},
+    {"scroll_screen/long",      bench_scroll_long,      1u<<19},
+    {"scroll_screen/symbols",   bench_scroll_symbols,   1u<<19},
+    {"screen_restart/switch",   bench_mode_switch,      1u<<18},
+    {"disp_char/frame",         bench_disp_char,        1u<<17},
+    {"brightness/update",       bench_brightness,       1u<<19},
+};
+#define NUM_BENCHMARKS (sizeof(benchmarks)/sizeof(benchmarks[0]))
+
+struct result {
+    double ns_per_op;
+    double p50_ns;
+    double p99_ns;
+    double rel;
+    double m0_ops[M0_NUM_OP_CLASSES];
+    double m0_cycles;
+};
+
+/*--------------------------------------------------
+ * M0+ cycle model - see host/m0_model.hpp
+ */
+static const char * m0_op_names[M0_NUM_OP_CLASSES] = {
+#define M0_OP_NAME(name, cycles) #name,
+    M0_OP_CLASSES(M0_OP_NAME)
+#undef M0_OP_NAME
+};
+static const uint32_t m0_op_cycles[M0_NUM_OP_CLASSES] = {
+#define M0_OP_CYCLES(name, cycles) cycles,
+    M0_OP_CLASSES(M0_OP_CYCLES)
+#undef M0_OP_CYCLES
+};
+static const uint8_t m0_block_ops[M0_NUM_BLOCKS][M0_NUM_OP_CLASSES] = {
+#define M0_BLOCK_OPS(name, ...) {__VA_ARGS__},
+    M0_BLOCKS(M0_BLOCK_OPS)
+#undef M0_BLOCK_OPS
+};
+
+// Instructions per op of each class, and estimated cycles per op. Starts each
+// benchmark from the same display state so the counts never change between runs
+static void m0_estimate(const benchmark * b, result * r){
+    screen_restart(default_msgs[1]);
+    memset(m0_block_runs, 0, sizeof(m0_block_runs));
+    b->run(b->iters);
+    r->m0_cycles = 0;
+    for(size_t op = 0; op < M0_NUM_OP_CLASSES; op++){
+        uint64_t count = 0;
+        for(size_t block = 0; block < M0_NUM_BLOCKS; block++){
+            count += m0_block_runs[block] * m0_block_ops[block][op];
+        }
+        r->m0_ops[op] = (double)count / b->iters;
+        r->m0_cycles += r->m0_ops[op] * m0_op_cycles[op];
+    }
+}
+
+static double time_per_op(void (*run)(uint32_t n), uint32_t n){
+    uint64_t start = now_ns();
+    run(n);
+    return (double)(now_ns() - start) / n;
+}
+
+// Fastest ns/op of every benchmark over ROUNDS interleaved rounds, and of the calibration loop
+static void measure_all(double * calibration_ns, double * ns_per_op){
+    *calibration_ns = 1e30;
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        ns_per_op[i] = 1e30;
+    }
+    for(int round = 0; round < ROUNDS; round++){
+        *calibration_ns = std::min(*calibration_ns, time_per_op(run_calibration, CALIBRATION_ITERS));
+        for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+            ns_per_op[i] = std::min(ns_per_op[i], time_per_op(benchmarks[i].run, benchmarks[i].iters));
+        }
+    }
+}
+
+// Fastest rel of one benchmark, interleaved with the calibration loop
+static double measure_rel(const benchmark * b){
+    double calibration_ns = 1e30, ns = 1e30;
+    for(int round = 0; round < ROUNDS; round++){
+        calibration_ns = std::min(calibration_ns, time_per_op(run_calibration, CALIBRATION_ITERS));
+        ns = std::min(ns, time_per_op(b->run, b->iters));
+    }
+    return ns / calibration_ns;
+}
+
+static void latency_per_op(void (*run)(uint32_t n), double * p50, double * p99){
+    std::vector<double> samples(LATENCY_SAMPLES);
+    for(uint32_t i = 0; i < LATENCY_SAMPLES; i++){
+        uint64_t start = now_ns();
+        run(LATENCY_BATCH);
+        samples[i] = (double)(now_ns() - start) / LATENCY_BATCH;
+    }
+    std::sort(samples.begin(), samples.end());
+    *p50 = samples[LATENCY_SAMPLES/2];
+    *p99 = samples[(LATENCY_SAMPLES*99)/100];
+}
+
+/*--------------------------------------------------
+ * Baselines file: "<name> <rel> <M0+ cycles>" per line, # for comments
+ */
+static bool lookup_baseline(const char * path, const char * name, double * rel, double * m0_cycles){
+    FILE * f = fopen(path, "r");
+    if(!f) return false;
+    char line[128];
+    bool found = false;
+    while(fgets(line, sizeof(line), f)){
+        char line_name[64];
+        double line_rel, line_m0_cycles;
+        if(line[0] == '#') continue;
+        if((sscanf(line, "%63s %lf %lf", line_name, &line_rel, &line_m0_cycles) == 3) && !strcmp(line_name, name)){
+            *rel = line_rel;
+            *m0_cycles = line_m0_cycles;
+            found = true;
+            break;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+static int write_baselines(const char * path, const result * results){
+    FILE * f = fopen(path, "w");
+    if(!f){
+        printf("Couldn't open %s for writing\n", path);
+        return 1;
+    }
+    fprintf(f, "# <name> <rel> <M0+ cycles>, written by render_bench --update\n");
+    fprintf(f, "# rel: host cost per op in calibration loop iterations, fastest of %d measurements (%d rounds each)\n", UPDATE_PASSES, ROUNDS);
+    fprintf(f, "# M0+ cycles: estimated cycles per op from the op-count model in host/m0_model.hpp\n");
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        fprintf(f, "%s %.2f %.1f\n", benchmarks[i].name, results[i].rel, results[i].m0_cycles);
+    }
+    fclose(f);
+    printf("Wrote baselines to %s\n", path);
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    const char * baseline_path = NULL;
+    bool update = false;
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "--update")){
+            update = true;
+        }
+        else{
+            baseline_path = argv[i];
+        }
+    }
+
+    init_msgs();
+    screen_restart(default_msgs[1]);
+    // Get the brightness pipeline past its baseline phase so we time the steady state
+    for(uint32_t i = 0; i < BASELINE_SAMPLES; i++){
+        bench_brightness(1);
+    }
+
+    double calibration_ns;
+    double ns_per_op[NUM_BENCHMARKS];
+    result results[NUM_BENCHMARKS];
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        m0_estimate(&benchmarks[i], &results[i]);
+    }
+    measure_all(&calibration_ns, ns_per_op);
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        results[i].ns_per_op = ns_per_op[i];
+        results[i].rel = ns_per_op[i] / calibration_ns;
+    }
+    if(update){
+        for(int pass = 1; pass < UPDATE_PASSES; pass++){
+            measure_all(&calibration_ns, ns_per_op);
+            for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+                results[i].ns_per_op = std::min(results[i].ns_per_op, ns_per_op[i]);
+                results[i].rel = std::min(results[i].rel, ns_per_op[i] / calibration_ns);
+            }
+        }
+    }
+
+    printf("Calibration loop: %.3f host ns per iteration\n\n", calibration_ns);
+    printf("%-24s %10s %12s %10s %10s %10s %10s %10s %10s\n", "benchmark", "ns/op", "ops/s", "p50 ns", "p99 ns",
+        "rel", "baseline", "M0+ cyc", "baseline");
+
+    int regressions = 0;
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        result * r = &results[i];
+        latency_per_op(benchmarks[i].run, &r->p50_ns, &r->p99_ns);
+
+        double baseline = 0, m0_baseline = 0;
+        bool have_baseline = !update && baseline_path && lookup_baseline(baseline_path, benchmarks[i].name, &baseline, &m0_baseline);
+        const char * status = "";
+        if(have_baseline){
+            double limit = baseline * (1.0 + BASELINE_TOLERANCE);
+            // Measure again before calling it a regression, in case that was just a noisy patch
+            for(int check = 1; (check < RECHECKS) && (r->rel > limit); check++){
+                r->rel = std::min(r->rel, measure_rel(&benchmarks[i]));
+            }
+            bool host_regressed = r->rel > limit;
+            bool m0_regressed = r->m0_cycles > m0_baseline * (1.0 + M0_TOLERANCE);
+            if(host_regressed || m0_regressed){
+                status = host_regressed ? (m0_regressed ? "  REGRESSED (host, M0+)" : "  REGRESSED (host)") : "  REGRESSED (M0+)";
+                regressions++;
+            }
+        }
+        else if(!update){
+            status = "  (no baseline)";
+        }
+        printf("%-24s %10.1f %12.0f %10.1f %10.1f %10.2f %10.2f %10.1f %10.1f%s\n", benchmarks[i].name,
+            r->ns_per_op, 1e9/r->ns_per_op, r->p50_ns, r->p99_ns, r->rel, baseline, r->m0_cycles, m0_baseline, status);
+    }
+
+    printf("\nM0+ model, instructions per op:\n%-24s", "benchmark");
+    for(size_t op = 0; op < M0_NUM_OP_CLASSES; op++){
+        printf(" %8s", m0_op_names[op]);
+    }
+    printf("\n%-24s", "(cycles each)");
+    for(size_t op = 0; op < M0_NUM_OP_CLASSES; op++){
+        printf(" %8u", (unsigned)m0_op_cycles[op]);
+    }
+    printf("\n");
+    for(size_t i = 0; i < NUM_BENCHMARKS; i++){
+        printf("%-24s", benchmarks[i].name);
+        for(size_t op = 0; op < M0_NUM_OP_CLASSES; op++){
+            printf(" %8.2f", results[i].m0_ops[op]);
+        }
+        printf("\n");
+    }
+
+    if(update){
+        if(!baseline_path){
+            printf("--update needs a baselines file\n");
+            return 1;
+        }
+        return write_baselines(baseline_path, results);
+    }
+    if(regressions){
+        printf("\n%d benchmark(s) more than %.0f%% (host) or %.0f%% (M0+) over baseline\n", regressions,
+            BASELINE_TOLERANCE*100, M0_TOLERANCE*100);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#ifndef BENCH_HOST_M0_MODEL_HPP
+#define BENCH_HOST_M0_MODEL_HPP
+// M0+ cycle model for the host benchmarks. The firmware marks its blocks with
+// M0_COST() (m0_cost.hpp), which counts runs into m0_block_runs[] here. Each block
+// has a hand counted Thumb-1 instruction mix for what arm-none-eabi-gcc emits
+// for it, and each instruction class a Cortex-M0+ cycle cost, so the counts
+// give estimated cycles per op. The host's hardware 64 bit multiply, divide and
+// float don't hide anything this way - __aeabi_lmul etc. are costed as the
+// RP2040 library calls they turn into.
+//
+// It's an estimate - no pipeline/flash wait states, and every branch is costed
+// as taken - but it only changes when the code paths or this table do.
+#include <stdint.h>
+
+// Instruction classes and their M0+ cycles (library calls include call/return)
+#define M0_OP_CLASSES(X) \
+    X(alu,      1)  /* data processing, compares, muls (single cycle multiplier) */ \
+    X(load,     2)  /* ldr/ldrb/ldrh, including literal pool loads */ \
+    X(store,    2)  /* str/strb/strh */ \
+    X(branch,   2)  /* conditional or unconditional branch */ \
+    X(call,     6)  /* bl + return, push/pop of a couple of registers */ \
+    X(lmul,     20) /* __aeabi_lmul, 32x32->64 multiply (pico_int64_ops) */ \
+    X(uidiv,    20) /* __aeabi_uidiv(mod), via the SIO hardware divider (pico_divider) */ \
+    X(ldivmod,  100)/* __aeabi_ldivmod, 64 bit divide (pico_divider) */ \
+    X(fp,       60) /* soft-float add/mul/div/convert (bootrom) */
+
+enum m0_op_class {
+#define M0_OP_ENUM(name, cycles) M0_OP_##name,
+    M0_OP_CLASSES(M0_OP_ENUM)
+#undef M0_OP_ENUM
+    M0_NUM_OP_CLASSES
+};
+
+// Instructions per run of each block, in M0_OP_CLASSES order:
+//      block                       alu load store branch call lmul uidiv ldivmod fp
+#define M0_BLOCKS(X) \
+    /* char_to_matrix(), per return - each failed range test is ~2 alu + 1 branch */ \
+    X(char_to_matrix_alpha,         7,  1,  0,  1,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_digit,         8,  1,  0,  2,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_symbols,       10, 1,  0,  3,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_symbols2,      12, 1,  0,  4,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_symbols3,      14, 1,  0,  5,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_symbols4,      16, 1,  0,  6,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_icon,          18, 1,  0,  7,  1,  0,  0,  0,  0) \
+    X(char_to_matrix_default,       16, 1,  0,  7,  1,  0,  0,  0,  0) \
+    /* scroll path - scroll_chars() is a 13 byte copy loop, the memset in */ \
+    /* add_char_to_scroll() is dead and the 5 byte memcpys are inlined */ \
+    X(scroll_chars,                 28, 14, 14, 13, 1,  0,  0,  0,  0) \
+    X(scroll_screen,                3,  2,  1,  1,  1,  0,  0,  0,  0) \
+    X(scroll_screen_next_char,      6,  6,  2,  0,  1,  0,  1,  0,  0) \
+    X(strlen_char,                  2,  1,  0,  1,  0,  0,  0,  0,  0) \
+    X(add_char_to_scroll,           3,  6,  6,  0,  1,  0,  0,  0,  0) \
+    X(add_char_to_scroll_start,     29, 6,  19, 14, 2,  0,  0,  0,  0) \
+    X(screen_restart,               4,  4,  2,  0,  1,  0,  0,  0,  0) \
+    /* disp_char() - entry includes led_on_time_us()'s clamp and the row loop */ \
+    X(disp_char,                    27, 9,  0,  7,  1,  0,  0,  0,  0) \
+    X(disp_char_pixel,              5,  0,  0,  2,  0,  0,  0,  0,  0) \
+    X(disp_char_lit,                11, 2,  0,  2,  0,  0,  0,  0,  0) \
+    /* SDK - gpio_put_masked() is inline, sleep_us() is just entry/exit, not the wait */ \
+    X(gpio_put_masked,              2,  2,  1,  0,  0,  0,  0,  0,  0) \
+    X(sleep_us,                     10, 4,  0,  3,  2,  0,  0,  0,  0) \
+    /* update_brightness() - target/smoothing are inlined, their multiplies counted below */ \
+    X(update_brightness,            27, 12, 4,  10, 1,  0,  0,  0,  0) \
+    X(update_brightness_baseline,   5,  3,  4,  1,  0,  0,  0,  1,  0) \
+    /* fixed_point.hpp - 64 bit add/shift around the multiply, 2 divides in from_ratio */ \
+    X(fixed_mul,                    5,  0,  0,  0,  0,  1,  0,  0,  0) \
+    X(fixed_mul_int,                3,  0,  0,  0,  0,  1,  0,  0,  0) \
+    X(fixed_round_to,               5,  0,  0,  0,  0,  1,  0,  0,  0) \
+    X(fixed_from_ratio,             3,  0,  0,  0,  0,  0,  2,  0,  0)
+
+enum m0_block {
+#define M0_BLOCK_ENUM(name, ...) M0_BLOCK_##name,
+    M0_BLOCKS(M0_BLOCK_ENUM)
+#undef M0_BLOCK_ENUM
+    M0_NUM_BLOCKS
+};
+
+// Defined by the benchmark
+extern uint64_t m0_block_runs[M0_NUM_BLOCKS];
+
+// Not counted while the compiler evaluates constexpr code (e.g. constants)
+#define M0_COST_N(block, n) \
+    (__builtin_is_constant_evaluated() ? (void)0 : (void)(m0_block_runs[M0_BLOCK_##block] += (n)))
+#define M0_COST(block) M0_COST_N(block, 1)
+
+#endif
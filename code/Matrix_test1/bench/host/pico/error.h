@@ -0,0 +1,3 @@
+#ifndef BENCH_HOST_PICO_ERROR_H
+#define BENCH_HOST_PICO_ERROR_H
+#endif
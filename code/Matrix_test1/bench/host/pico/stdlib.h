@@ -0,0 +1,33 @@
+#ifndef BENCH_HOST_PICO_STDLIB_H
+#define BENCH_HOST_PICO_STDLIB_H
+// Just enough of the pico SDK to build the rendering code on the host for benchmarking.
+// GPIO writes go to a dummy register and sleeps only advance a fake clock, so the
+// benchmarks measure the CPU work and not the LED timing. Both are counted for the
+// M0+ cycle model as what they cost on the real SDK.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "m0_cost.hpp"
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+extern volatile uint32_t host_gpio_out;
+extern uint64_t host_time_us;
+
+static inline void gpio_put_masked(uint32_t mask, uint32_t value){
+    M0_COST(gpio_put_masked);
+    host_gpio_out = (host_gpio_out & ~mask) | (value & mask);
+}
+static inline void sleep_us(uint64_t us){
+    M0_COST(sleep_us);
+    host_time_us += us;
+}
+static inline absolute_time_t get_absolute_time(void){
+    return host_time_us;
+}
+static inline uint32_t to_ms_since_boot(absolute_time_t t){
+    return (uint32_t)(t / 1000);
+}
+
+#endif
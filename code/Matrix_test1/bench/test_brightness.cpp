@@ -0,0 +1,183 @@
+/*--------------------------------------------------
+ * test_brightness.cpp
+ * Host test checking the fixed point brightness path against the float maths
+ * it replaced: from_ratio() averaging, the baseline average, target brightness,
+ * smoothing, the whole update_brightness() pipeline and disp_char()'s LED on
+ * time. Brightness/temperature values must agree to within TOLERANCE, on
+ * times must match the float truncation exactly.
+ *
+ * Exits with 1 on any failure.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "matrix_display.hpp"
+#include "brightness.hpp"
+
+// 1/4096 = ~0.02% brightness, or 1/4096 of an ADC count
+#define TOLERANCE (1.0 / 4096)
+
+volatile uint32_t host_gpio_out = 0;
+uint64_t host_time_us = 0;
+
+static int failures = 0;
+
+static void check(bool ok, const char * name, const char * fmt, double a, double b){
+    if(!ok){
+        printf("FAIL %s: ", name);
+        printf(fmt, a, b);
+        printf("\n");
+        failures++;
+    }
+}
+
+/*--------------------------------------------------
+ * Float reference - the original float implementation
+ */
+static float target_brightness_ref(float temp_diff){
+    float abs_temp_diff = fabsf(temp_diff);
+    float b = abs_temp_diff * abs_temp_diff * TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF;
+    if (b > MAX_BRIGHTNESS) b = MAX_BRIGHTNESS;
+    if (b < MIN_BRIGHTNESS) b = MIN_BRIGHTNESS;
+    return b;
+}
+
+static float smooth_brightness_ref(float current, float target){
+    if (target < current) {
+        return current * 0.3f + target * 0.7f;
+    }
+    return current * 0.98f + target * 0.02f;
+}
+
+static float current_brightness_ref = MIN_BRIGHTNESS;
+static float baseline_adc_temp_ref = 0;
+
+static void update_brightness_ref(uint16_t raw_adc_temp){
+    static float adc_history[AVERAGE_WINDOW] = {0};
+    static uint8_t adc_index = 0;
+    static bool history_filled = false;
+
+    adc_history[adc_index] = raw_adc_temp;
+    adc_index = (adc_index + 1) % AVERAGE_WINDOW;
+    if (adc_index == 0) history_filled = true;
+
+    float adc_temp = 0;
+    uint8_t samples = history_filled ? AVERAGE_WINDOW : (adc_index == 0 ? AVERAGE_WINDOW : adc_index);
+    for (uint8_t i = 0; i < samples; i++) {
+        adc_temp += adc_history[i];
+    }
+    adc_temp /= samples;
+
+    static uint8_t baseline_count = 0;
+    static float baseline_sum = 0;
+    if (baseline_count < BASELINE_SAMPLES) {
+        baseline_sum += adc_temp;
+        baseline_count++;
+        baseline_adc_temp_ref = BASELINE_OFFSET + (baseline_sum / baseline_count);
+    }
+
+    float target = target_brightness_ref(adc_temp - baseline_adc_temp_ref);
+    current_brightness_ref = smooth_brightness_ref(current_brightness_ref, target);
+}
+
+/*--------------------------------------------------
+ * Tests
+ */
+// Every window sum / sample count the averaging can produce
+static void test_from_ratio(void){
+    for(uint32_t den = 1; den <= AVERAGE_WINDOW; den++){
+        for(uint32_t num = 0; num <= den*4095; num++){
+            double got = q16_16::from_ratio(num, den).to_float();
+            double want = (double)num / den;
+            if(fabs(got - want) > TOLERANCE){
+                check(false, "from_ratio", "%f vs %f", got, want);
+                return;
+            }
+        }
+    }
+}
+
+static void test_target_brightness(void){
+    for(int32_t i = -8*1024; i <= 8*1024; i++){
+        q16_16 diff = q16_16::from_raw(i * (q16_16::ONE/1024));
+        double got = target_brightness_from_diff(diff).to_float();
+        double want = target_brightness_ref(diff.to_float());
+        if(fabs(got - want) > TOLERANCE){
+            check(false, "target_brightness_from_diff", "%f vs %f", got, want);
+            return;
+        }
+    }
+}
+
+// Full brighten then dim, from each end of the range
+static void test_smoothing(void){
+    q16_16 current = MIN_BRIGHTNESS_Q;
+    float current_ref = MIN_BRIGHTNESS;
+    for(int i = 0; i < 600; i++){
+        float target_ref = (i < 400) ? MAX_BRIGHTNESS : MIN_BRIGHTNESS;
+        q16_16 target = (i < 400) ? MAX_BRIGHTNESS_Q : MIN_BRIGHTNESS_Q;
+        current = smooth_brightness(current, target);
+        current_ref = smooth_brightness_ref(current_ref, target_ref);
+        if(fabs(current.to_float() - current_ref) > TOLERANCE){
+            check(false, "smooth_brightness", "%f vs %f", current.to_float(), current_ref);
+            return;
+        }
+    }
+}
+
+// Baseline phase on a noisy room temperature, then warm up by ~3 counts and cool back down
+static uint16_t adc_trace(uint32_t i){
+    int32_t drift = 0;
+    if(i >= BASELINE_SAMPLES){
+        int32_t t = (int32_t)(i - BASELINE_SAMPLES);
+        drift = (t < 400) ? (t / 100) : ((t < 800) ? 3 - ((t - 400) / 100) : 0);
+    }
+    return (uint16_t)(873 + drift + ((i*2654435761u) >> 30));
+}
+
+static void test_pipeline(void){
+    for(uint32_t i = 0; i < BASELINE_SAMPLES + 1000; i++){
+        uint16_t raw = adc_trace(i);
+        update_brightness(raw, 0);
+        update_brightness_ref(raw);
+        if(fabs(baseline_adc_temp.to_float() - baseline_adc_temp_ref) > TOLERANCE){
+            check(false, "baseline_adc_temp", "%f vs %f", baseline_adc_temp.to_float(), baseline_adc_temp_ref);
+            return;
+        }
+        if(fabs(current_brightness.to_float() - current_brightness_ref) > TOLERANCE){
+            check(false, "current_brightness", "%f vs %f", current_brightness.to_float(), current_brightness_ref);
+            return;
+        }
+    }
+}
+
+// disp_char()'s on time used to be (uint)(LED_period_us * brightness) after clamping to 0-1
+static void test_on_time(void){
+    for(int32_t raw = -q16_16::ONE; raw <= 2*q16_16::ONE; raw++){
+        q16_16 brightness = q16_16::from_raw(raw);
+        float b = brightness.to_float();
+        if (b < 0.0f) b = 0.0f;
+        if (b > 1.0f) b = 1.0f;
+        uint want = (uint)(LED_period_us * b);
+        uint got = led_on_time_us(brightness);
+        if(got != want){
+            check(false, "led_on_time_us", "%.0f vs %.0f", got, want);
+            return;
+        }
+    }
+}
+
+int main(void){
+    test_from_ratio();
+    test_target_brightness();
+    test_smoothing();
+    test_pipeline();
+    test_on_time();
+    if(failures){
+        printf("%d brightness check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All brightness checks passed\n");
+    return 0;
+}
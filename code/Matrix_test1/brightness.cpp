@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include "brightness.hpp"
+#include "m0_cost.hpp"
+
+q16_16 current_brightness = MIN_BRIGHTNESS_Q;
+q16_16 baseline_adc_temp = Q16_ZERO;
+
+constexpr q16_16 PERCENT = q16_16::from_int(100);
+
+// Splits a value into sign/units/tenths for printf(Q16_FMT) - avoids dragging in float printf
+#define Q16_FMT "%s%ld.%ld"
+#define Q16_ARGS(x) (((x).raw < 0) ? "-" : ""), (long)((x).abs().round_to(10) / 10), (long)((x).abs().round_to(10) % 10)
+
+// Feed one temperature sensor reading through the averaging/baseline/smoothing
+// pipeline and update current_brightness. now (ms) is only used for debug prints.
+void update_brightness(uint16_t raw_adc_temp, uint32_t now) {
+#if DEBUG_TEMPERATURE_PRINT
+    static uint32_t last_debug_print = 0;
+#endif
+
+    static uint16_t adc_history[AVERAGE_WINDOW] = {0};
+    static uint32_t adc_history_sum = 0;
+    static uint8_t adc_index = 0;
+    static bool history_filled = false;
+
+    M0_COST(update_brightness);
+    // Add to averaging window of AVERAGE_WINDOW samples (running sum, so no loop)
+    adc_history_sum = adc_history_sum - adc_history[adc_index] + raw_adc_temp;
+    adc_history[adc_index] = raw_adc_temp;
+    adc_index = (adc_index + 1) % AVERAGE_WINDOW;
+    if (adc_index == 0) history_filled = true;
+    
+    // Calculate average temperature
+    uint8_t samples = history_filled ? AVERAGE_WINDOW : (adc_index == 0 ? AVERAGE_WINDOW : adc_index);
+    q16_16 adc_temp = q16_16::from_ratio(adc_history_sum, samples);
+    
+    static uint8_t baseline_count = 0;
+    static int64_t baseline_sum = 0;
+    
+    // Measure baseline temperature over first BASELINE_SAMPLES readings
+    // (64 bit divide, but only for the first few seconds)
+    if (baseline_count < BASELINE_SAMPLES) {
+        M0_COST(update_brightness_baseline);
+        baseline_sum += adc_temp.raw;
+        baseline_count++;
+        baseline_adc_temp = BASELINE_OFFSET_Q + q16_16::from_raw((int32_t)(baseline_sum / baseline_count));
+        if (baseline_count == BASELINE_SAMPLES) {
+            printf("Baseline ADC temp (averaged): " Q16_FMT "\n", Q16_ARGS(baseline_adc_temp));
+        }
+    }
+
+    q16_16 temp_diff = adc_temp - baseline_adc_temp;
+    q16_16 target_brightness = target_brightness_from_diff(temp_diff);
+    current_brightness = smooth_brightness(current_brightness, target_brightness);
+
+#if DEBUG_TEMPERATURE_PRINT
+    if (now - last_debug_print > 1000) {
+        q16_16 brightness_percent = current_brightness * PERCENT;
+        printf("ADC: " Q16_FMT ", Baseline: " Q16_FMT ", RawDiff: " Q16_FMT ", AbsDiff: " Q16_FMT ", Brightness: " Q16_FMT "%%\n", 
+               Q16_ARGS(adc_temp), Q16_ARGS(baseline_adc_temp), Q16_ARGS(temp_diff), Q16_ARGS(temp_diff.abs()), Q16_ARGS(brightness_percent));
+        last_debug_print = now;
+    }
+#endif
+}
+
@@ -0,0 +1,58 @@
+#ifndef BRIGHTNESS_HPP
+#define BRIGHTNESS_HPP
+#include <stdint.h>
+#include "fixed_point.hpp"
+
+// Number of temperature samples of the "baseline" room temperature to take on startup
+#define BASELINE_SAMPLES 128
+// Offset to add to baseline to account for self-heating after turning on the card
+#define BASELINE_OFFSET -0.1f
+// Number of samples to average for temperature reading
+#define AVERAGE_WINDOW 32
+// ADC reading to brightness coefficient
+#define TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF 0.15f
+// Minimum and maximum brightness levels
+#define MAX_BRIGHTNESS 1.0f
+#define MIN_BRIGHTNESS 0.05f
+
+#define DEBUG_TEMPERATURE_PRINT 1
+
+// Fixed point versions of the above. Runtime code should only use these - being
+// constexpr variables, they're converted at compile time even in unoptimised builds
+constexpr q16_16 BASELINE_OFFSET_Q = q16_16::from_float(BASELINE_OFFSET);
+constexpr q16_16 TEMP_TO_BRIGHTNESS_Q = q16_16::from_float(TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF);
+constexpr q16_16 MAX_BRIGHTNESS_Q = q16_16::from_float(MAX_BRIGHTNESS);
+constexpr q16_16 MIN_BRIGHTNESS_Q = q16_16::from_float(MIN_BRIGHTNESS);
+// Fraction of the way to the target brightness to move each update
+constexpr q16_16 DIM_RATE = q16_16::from_float(0.7f);
+constexpr q16_16 BRIGHTEN_RATE = q16_16::from_float(0.02f);
+
+extern q16_16 current_brightness;
+extern q16_16 baseline_adc_temp;
+
+// Anything over this saturates at MAX_BRIGHTNESS anyway, clamping first stops the square overflowing
+constexpr q16_16 TEMP_DIFF_LIMIT = q16_16::from_int(16);
+static_assert(TEMP_DIFF_LIMIT.to_float() * TEMP_DIFF_LIMIT.to_float() * TEMP_TO_BRIGHTNESS_QUADRATIC_COEFF > MAX_BRIGHTNESS,
+              "TEMP_DIFF_LIMIT must saturate brightness");
+
+// Brightness for a given (ADC count) difference from baseline temperature
+constexpr q16_16 target_brightness_from_diff(q16_16 temp_diff){
+    // Absolute, so heating and cooling have same effect
+    q16_16 abs_temp_diff = temp_diff.abs().clamp(Q16_ZERO, TEMP_DIFF_LIMIT);
+    q16_16 brightness_change = abs_temp_diff * abs_temp_diff * TEMP_TO_BRIGHTNESS_Q;
+    // Clamp brightness to 5% to 100% of max brightness
+    return brightness_change.clamp(MIN_BRIGHTNESS_Q, MAX_BRIGHTNESS_Q);
+}
+
+// Smoothly update current brightness - faster decay when decreasing
+constexpr q16_16 smooth_brightness(q16_16 current, q16_16 target){
+    if (target < current) {
+        // Faster response when dimming
+        return current + (target - current) * DIM_RATE;
+    }
+    // Slower response when brightening
+    return current + (target - current) * BRIGHTEN_RATE;
+}
+
+void update_brightness(uint16_t raw_adc_temp, uint32_t now);
+#endif
@@ -0,0 +1,93 @@
+#ifndef FIXED_POINT_HPP
+#define FIXED_POINT_HPP
+#include <stdint.h>
+#include "m0_cost.hpp"
+
+// Signed fixed point number with FRAC fractional bits, stored in an int32_t.
+// The RP2040's M0+ cores have no FPU, so every float op is a soft-float library
+// call - use this in anything that runs per display cycle instead.
+// Everything is constexpr, so constants can be written as floats and get
+// converted at compile time (from_float should never end up in the binary).
+template<int FRAC>
+struct fixed {
+    static_assert((FRAC > 0) && (FRAC < 31), "fixed: FRAC must be 1-30");
+    static constexpr int32_t ONE = (int32_t)1 << FRAC;
+
+    int32_t raw;
+
+    static constexpr fixed from_raw(int32_t r){
+        return fixed{r};
+    }
+    static constexpr fixed from_int(int32_t i){
+        return fixed{i * ONE};
+    }
+    // Rounds to nearest - only meant for compile time constants
+    static constexpr fixed from_float(float f){
+        return fixed{(int32_t)(f * ONE + ((f < 0) ? -0.5f : 0.5f))};
+    }
+    // num/den without a 64 bit divide. Only valid for den < 2^(32-FRAC) (so the
+    // shifted remainder fits) and num/den < 2^(31-FRAC) (so the result fits)
+    static constexpr fixed from_ratio(uint32_t num, uint32_t den){
+        M0_COST(fixed_from_ratio);
+        return fixed{(int32_t)(((num / den) << FRAC) + (((num % den) << FRAC) / den))};
+    }
+
+    constexpr float to_float(void) const {
+        return (float)raw / ONE;
+    }
+    // Rounds towards -inf
+    constexpr int32_t to_int(void) const {
+        return raw >> FRAC;
+    }
+    // this * i, truncated to an integer (same as casting the float result, for positive values)
+    constexpr int32_t mul_int(int32_t i) const {
+        M0_COST(fixed_mul_int);
+        return (int32_t)(((int64_t)raw * i) >> FRAC);
+    }
+    // this * scale, rounded to nearest. Used for printing, e.g. round_to(10) = tenths
+    constexpr int32_t round_to(int32_t scale) const {
+        M0_COST(fixed_round_to);
+        return (int32_t)((((int64_t)raw * scale) + (ONE/2)) >> FRAC);
+    }
+
+    constexpr fixed abs(void) const {
+        return fixed{(raw < 0) ? -raw : raw};
+    }
+    constexpr fixed clamp(fixed lo, fixed hi) const {
+        return (raw < lo.raw) ? lo : ((raw > hi.raw) ? hi : *this);
+    }
+
+    constexpr fixed operator+(fixed b) const { return fixed{raw + b.raw}; }
+    constexpr fixed operator-(fixed b) const { return fixed{raw - b.raw}; }
+    constexpr fixed operator-(void) const { return fixed{-raw}; }
+    // Rounded to nearest, so repeated multiplies (e.g. filters) don't drift downwards
+    constexpr fixed operator*(fixed b) const {
+        M0_COST(fixed_mul);
+        return fixed{(int32_t)((((int64_t)raw * b.raw) + (ONE/2)) >> FRAC)};
+    }
+    fixed& operator+=(fixed b){ raw += b.raw; return *this; }
+    fixed& operator-=(fixed b){ raw -= b.raw; return *this; }
+
+    constexpr bool operator<(fixed b) const { return raw < b.raw; }
+    constexpr bool operator>(fixed b) const { return raw > b.raw; }
+    constexpr bool operator<=(fixed b) const { return raw <= b.raw; }
+    constexpr bool operator>=(fixed b) const { return raw >= b.raw; }
+    constexpr bool operator==(fixed b) const { return raw == b.raw; }
+    constexpr bool operator!=(fixed b) const { return raw != b.raw; }
+};
+
+// 15 integer bits is plenty for 12 bit ADC readings, 16 fractional bits keeps
+// brightness well under the 1us (1%) PWM step
+typedef fixed<16> q16_16;
+
+constexpr q16_16 Q16_ZERO = q16_16::from_int(0);
+constexpr q16_16 Q16_ONE = q16_16::from_int(1);
+
+static_assert(q16_16::from_float(1.0f).raw == 0x10000, "q16_16: 1.0");
+static_assert(q16_16::from_float(-0.5f).raw == -0x8000, "q16_16: -0.5");
+static_assert(q16_16::from_ratio(3, 2) == q16_16::from_float(1.5f), "q16_16: ratio");
+static_assert((q16_16::from_float(1.5f) * q16_16::from_float(-2.0f)) == q16_16::from_int(-3), "q16_16: mul");
+static_assert(q16_16::from_float(0.5f).mul_int(100) == 50, "q16_16: mul_int");
+static_assert(q16_16::from_float(-0.26f).round_to(10) == -3, "q16_16: round_to");
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef M0_COST_HPP
+#define M0_COST_HPP
+// M0_COST(block) marks a block of code for the host benchmark's M0+ cycle model,
+// which counts how many times each block runs and what it costs in Thumb-1
+// instructions (bench/host/m0_model.hpp). M0_COST_N(block, n) counts it n times.
+// Both compile to nothing in the real build.
+#ifdef M0_COST_MODEL
+#include "m0_model.hpp"
+#else
+#define M0_COST(block)
+#define M0_COST_N(block, n)
+#endif
+#endif
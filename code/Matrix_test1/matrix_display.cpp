@@ -3,12 +3,11 @@
 #include "matrix_display.hpp"
 #include "pindefs.hpp"
 #include "string.h"
+#include "m0_cost.hpp"
 
 #include "clw_dbgutils.h"
 
 
-constexpr uint LED_period_us = 100;
-
 const uint8_t symbols[][5] = { //ascii 0x20 - 0x2F
     {(((0x03)<<5)|0b00000), 0b00000, 0b00000, 0b00000, 0b00000}, // (space)
     {(((0x03)<<5)|0b00000), 0b11101, 0b00000, 0b00000, 0b00000}, // !
@@ -138,26 +137,34 @@ const uint8_t icons[][5] = {
 };*/
 const uint8_t* char_to_matrix(const char charIn){
     if(((charIn >= 'A')&&(charIn <= 'Z'))||((charIn >= 'a')&&(charIn <= 'z'))){
+        M0_COST(char_to_matrix_alpha);
         return alphabet[(charIn&0x1F)-1];
     }
     if((charIn >= '0')&&(charIn <='9')){
+        M0_COST(char_to_matrix_digit);
         return numbers[charIn&0x0F];
     }
     if((charIn >= ' ')&&(charIn <='/')){
+        M0_COST(char_to_matrix_symbols);
         return symbols[charIn&0x0F];
     }
     if((charIn >= ':')&&(charIn <= '@')){
+        M0_COST(char_to_matrix_symbols2);
         return symbols2[charIn-0x3A];
     }
     if((charIn >= '[')&&(charIn <= '`')){
+        M0_COST(char_to_matrix_symbols3);
         return symbols3[charIn-0x5B];
     }
     if((charIn >= '{')&&(charIn <= '~')){
+        M0_COST(char_to_matrix_symbols4);
         return symbols4[charIn-0x7B];
     }
     if(charIn > 0x7F){
+        M0_COST(char_to_matrix_icon);
         return icons[charIn&0x7F];
     }
+    M0_COST(char_to_matrix_default);
     return symbols[0];
 }
 
@@ -178,11 +185,13 @@ inline void clear_matrix(void){
 
 uint8_t scroll_buff[15] = {0};
 void add_char_to_scroll_start(const uint8_t * character){
+    M0_COST(add_char_to_scroll_start);
     memset(&(scroll_buff[0]),0,14);
     memcpy(&(scroll_buff[0]), character,5);
 }
 //((character[0]&0xE0)>>5)
 void add_char_to_scroll(const uint8_t * character){
+    M0_COST(add_char_to_scroll);
     uint8_t prev_char_len = ((scroll_buff[0]&0xE0)>>5)+2;
     memset(&(scroll_buff[8]),0,5);
     memcpy(&(scroll_buff[8]), character,5);
@@ -213,6 +222,90 @@ void print_print_buff(void){
     printf("------------\n");
 }
 
+// Terminal mirror of the scroll buffer, drawn in rows 1-5. A full redraw also sets the
+// terminal's scroll region to start at MIRROR_CONSOLE_ROW, so the rest of our printf
+// output scrolls underneath the mirror instead of over it. Between full redraws only
+// cells that changed since the last mirrored frame are sent (cursor addressed), plus a
+// keyframe of every cell each MIRROR_KEYFRAME_FRAMES in case the terminal was reset.
+// Worst case is every other cell changing: 75 * (cursor + colour + digit) ~ 1KB
+#define MIRROR_CONSOLE_ROW 7
+#define MIRROR_KEYFRAME_FRAMES 50
+#if MIRROR_FPS
+static char mirror_out[1024];
+static uint8_t mirror_shadow[15] = {0};
+static bool mirror_valid = false;
+#endif
+
+void mirror_frame(const uint8_t * frame){
+#if MIRROR_FPS == 0
+    (void)frame;
+#else
+    static uint32_t last_frame_ms = 0;
+    static uint frames_since_keyframe = 0;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    // Only drop frames that come in well under the frame period, so frames from a
+    // timer that runs at (or jitters around) MIRROR_FPS aren't skipped
+    if(mirror_valid && (now - last_frame_ms < (3*1000)/(4*MIRROR_FPS))){
+        return;
+    }
+    last_frame_ms = now;
+
+    bool keyframe = !mirror_valid || (++frames_since_keyframe >= MIRROR_KEYFRAME_FRAMES);
+    if(keyframe){
+        frames_since_keyframe = 0;
+    }
+
+    uint len = 0;
+    if(!mirror_valid){
+        //reset the scroll region before clearing, so the clear covers the whole screen
+        len += sprintf(&mirror_out[len], "\033[r\033[2J");
+    }
+    else{
+        len += sprintf(&mirror_out[len], "\0337"); //save cursor so we don't disturb the console
+    }
+    int last_row = -1, last_col = -1, last_on = -1;
+    for(uint8_t i = 0; i < 5; i++){
+        for(uint8_t col = 0; col < 15; col++){
+            int on = (frame[col]>>(4-i))&0x01;
+            if(!keyframe && (on == ((mirror_shadow[col]>>(4-i))&0x01))){
+                continue;
+            }
+            if((last_row != i) || (last_col != col-1)){
+                len += sprintf(&mirror_out[len], "\033[%d;%dH", i+1, col+1);
+            }
+            if(on != last_on){
+                len += sprintf(&mirror_out[len], "%s", on?BG_BLUE:BG_BLACK);
+                last_on = on;
+            }
+            mirror_out[len++] = on?'1':'0';
+            last_row = i;
+            last_col = col;
+        }
+    }
+    if(keyframe){
+        //(re)set the scroll region, this homes the cursor on most terminals
+        len += sprintf(&mirror_out[len], COLOUR_NONE "\033[%dr", MIRROR_CONSOLE_ROW);
+    }
+    if(!mirror_valid){
+        len += sprintf(&mirror_out[len], "\033[%d;1H", MIRROR_CONSOLE_ROW); //park the cursor under the mirror
+    }
+    else if(keyframe){
+        len += sprintf(&mirror_out[len], "\0338");
+    }
+    else if(last_on >= 0){
+        len += sprintf(&mirror_out[len], COLOUR_NONE "\0338");
+    }
+    else{
+        len = 0; //nothing changed, don't send anything
+    }
+    if(len){
+        fwrite(mirror_out, 1, len, stdout);
+    }
+    memcpy(mirror_shadow, frame, sizeof(mirror_shadow));
+    mirror_valid = true;
+#endif
+}
+
 void print_matrix(const uint8_t * character){
     for(uint8_t i = 0; i < 5; i++){ 
         printf("%0d%0d%0d%0d%0d\n", 
@@ -226,25 +319,59 @@ void print_matrix(const uint8_t * character){
 }
 
 void scroll_chars(void){
+    M0_COST(scroll_chars);
     for(uint i = 0; i < 13; i++){
         scroll_buff[i] = scroll_buff[i+1];
     }
     scroll_buff[13] = 0;
 }
 
+static uint counter = 0;
+static uint scroll_count = 0;
+// Advance the display one column through str, pulling in the next character when needed
+void scroll_screen(const char * str){
+    M0_COST(scroll_screen);
+    scroll_chars();
+    scroll_count++;
+    if(scroll_count==7){
+        M0_COST(scroll_screen_next_char);
+        M0_COST_N(strlen_char, strlen(str)+1);
+        counter = (counter+1) % strlen(str);
+        const uint8_t * disp_char = char_to_matrix(str[counter]);
+        add_char_to_scroll(disp_char);
+        scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+    }
+}
 
+void screen_start(const char * str){
+    const uint8_t * disp_char = char_to_matrix(str[counter]);
+    add_char_to_scroll(disp_char);
+    scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+}
 
-void disp_char(const uint8_t * character, float brightness){
-    if (brightness < 0.0f) brightness = 0.0f;
-    if (brightness > 1.0f) brightness = 1.0f;
-    
+// Clear the display and start scrolling str from the beginning (e.g. on mode change)
+void screen_restart(const char * str){
+    M0_COST(screen_restart);
+    counter = 0;
+    const uint8_t * disp_char = char_to_matrix(str[counter]);
+    add_char_to_scroll_start(disp_char);
+    add_char_to_scroll(disp_char);
+    scroll_count=5-((disp_char[0]&0xE0)>>5); //3MSB of first col of char = length (0-7)
+}
+
+
+
+void disp_char(const uint8_t * character, q16_16 brightness){
+    M0_COST(disp_char);
     // Calculate on and off times based on duty cycle
-    uint on_time_us = (uint)(LED_period_us * brightness);
+    uint on_time_us = led_on_time_us(brightness);
     uint off_time_us = LED_period_us - on_time_us;
     
     for(uint8_t i = 0; i < 5; i++){ 
         for(uint8_t j = 0; j < 5; j++){
+            M0_COST(disp_char_pixel);
             if((character[i]>>(4-j))&0x01){
+                M0_COST(disp_char_lit);
                 static const uint rows[] = {LED_R1,LED_R2,LED_R3,LED_R4,LED_R5};
                 static const uint cols[] = {LED_C1,LED_C2,LED_C3,LED_C4,LED_C5};
                 
@@ -2,12 +2,29 @@
 #define MATRIX_DISPLAY_HPP
 #include <stdio.h>
 #include <pico/stdlib.h>
+#include "fixed_point.hpp"
+
+constexpr uint LED_period_us = 100;
+// Max rate the USB mirror of the display is redrawn at, 0 turns the mirror off.
+// It's fed once per scroll step (100ms timer), so anything over 10 has no effect.
+// Off by default as it takes over the terminal used to set the name string.
+#ifndef MIRROR_FPS
+#define MIRROR_FPS 0
+#endif
 extern uint8_t scroll_buff[15];
 const uint8_t* char_to_matrix(const char charIn);
-void disp_char(const uint8_t * character, float brightness);
+void disp_char(const uint8_t * character, q16_16 brightness);
+// On time per LED_period_us at a brightness (clamped to 0-1)
+inline uint led_on_time_us(q16_16 brightness){
+    return brightness.clamp(Q16_ZERO, Q16_ONE).mul_int(LED_period_us);
+}
 void scroll_chars(void);
 void add_char_to_scroll(const uint8_t * character);
 void add_char_to_scroll_start(const uint8_t * character);
+void scroll_screen(const char * str);
+void screen_start(const char * str);
+void screen_restart(const char * str);
 void print_matrix(const uint8_t * character);
 void print_print_buff(void);
+void mirror_frame(const uint8_t * frame);
 #endif
\ No newline at end of file